@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+// Binary layout of the pre-packed spatiotemporal blue noise file written by the BlueNoiseGenerator tool. The header is
+// immediately followed by depth layers of width * height 8-bit texels, layer-major, so the payload can be uploaded
+// straight into a 2D texture array without any decoding.
+
+#define BLUE_NOISE_FILE_MAGIC 0x4E425453 // 'STBN'
+#define BLUE_NOISE_FILE_VERSION 1
+
+struct BlueNoiseFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t data_offset;
+};
@@ -7,6 +7,7 @@
 #include <shadow_map.h>
 #include <hosek_wilkie_sky_model.h>
 #include <profiler.h>
+#include "blue_noise.h"
 #include <memory>
 #include <iostream>
 #include <stack>
@@ -15,12 +16,27 @@
 #include <random>
 #include <fstream>
 
+#if defined(_WIN32)
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
 #define CAMERA_NEAR_PLANE 1.0f
 #define CAMERA_FAR_PLANE 500.0f
 #define VOXEL_GRID_SIZE_X 160
 #define VOXEL_GRID_SIZE_Y 90
 #define VOXEL_GRID_SIZE_Z 128
-#define NUM_BLUE_NOISE_TEXTURES 16
+#define BLUE_NOISE_TEXTURE_SIZE 128
 
 struct UBO
 {
@@ -39,6 +55,80 @@ struct UBO
     glm::ivec4 width_height;
 };
 
+// Read-only memory mapping of a file, unmapped on destruction.
+struct MappedFile
+{
+    const uint8_t* data = nullptr;
+    size_t         size = 0;
+#if defined(_WIN32)
+    HANDLE file    = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    bool map(const std::string& path)
+    {
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER file_size;
+
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+            return false;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (!mapping)
+            return false;
+
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size = static_cast<size_t>(file_size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+
+        if (fd == -1)
+            return false;
+
+        struct stat file_stat;
+
+        if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void* ptr = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping stays valid after the descriptor is closed.
+        close(fd);
+
+        if (ptr == MAP_FAILED)
+            return false;
+
+        data = static_cast<const uint8_t*>(ptr);
+        size = static_cast<size_t>(file_stat.st_size);
+#endif
+        return data != nullptr;
+    }
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (data)
+            UnmapViewOfFile(data);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data)
+            munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+};
+
 class VolumetricLighting : public dw::Application
 {
 protected:
@@ -65,8 +155,9 @@ protected:
         // Create volume textures.
         create_textures();
 
-        // Load blue noise textures.
-        load_blue_noise_textures();
+        // Load blue noise texture array.
+        if (!load_blue_noise_texture())
+            return false;
 
         // Create UBO
         create_uniform_buffer();
@@ -305,20 +396,46 @@ private:
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
-    void load_blue_noise_textures()
+    bool load_blue_noise_texture()
     {
-        m_blue_noise_textures.resize(NUM_BLUE_NOISE_TEXTURES);
+        // Spatiotemporal blue noise generated at build time by the BlueNoiseGenerator tool, one layer per frame.
+        MappedFile file;
 
-        for (int i = 0; i < NUM_BLUE_NOISE_TEXTURES; i++)
+        if (!file.map("textures/blue_noise/stbn.bin"))
         {
-            auto texture = dw::gl::Texture2D::create_from_file("textures/blue_noise/LDR_LLL1_" + std::to_string(i) + ".png");
+            DW_LOG_FATAL("Failed to map blue noise file");
+            return false;
+        }
 
-            texture->set_min_filter(GL_NEAREST);
-            texture->set_mag_filter(GL_NEAREST);
-            texture->set_wrapping(GL_REPEAT, GL_REPEAT, GL_REPEAT);
+        const BlueNoiseFileHeader* header = reinterpret_cast<const BlueNoiseFileHeader*>(file.data);
 
-            m_blue_noise_textures[i] = texture;
+        if (file.size < sizeof(BlueNoiseFileHeader) || header->magic != BLUE_NOISE_FILE_MAGIC || header->version != BLUE_NOISE_FILE_VERSION)
+        {
+            DW_LOG_FATAL("Invalid blue noise file");
+            return false;
+        }
+
+        size_t layer_size = size_t(header->width) * size_t(header->height);
+
+        if (header->width != BLUE_NOISE_TEXTURE_SIZE || header->height != BLUE_NOISE_TEXTURE_SIZE || header->depth == 0 || file.size < header->data_offset + layer_size * header->depth)
+        {
+            DW_LOG_FATAL("Unexpected blue noise dimensions");
+            return false;
         }
+
+        m_blue_noise_layers  = header->depth;
+        m_blue_noise_texture = dw::gl::Texture2D::create(header->width, header->height, header->depth, 1, 1, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+
+        m_blue_noise_texture->set_min_filter(GL_NEAREST);
+        m_blue_noise_texture->set_mag_filter(GL_NEAREST);
+        m_blue_noise_texture->set_wrapping(GL_REPEAT, GL_REPEAT, GL_REPEAT);
+
+        const uint8_t* texels = file.data + header->data_offset;
+
+        for (uint32_t i = 0; i < header->depth; i++)
+            m_blue_noise_texture->set_data(i, 0, (void*)(texels + layer_size * i));
+
+        return true;
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
@@ -491,7 +608,7 @@ private:
             m_ray_march_voxel_grid->bind(5);
 
         if (m_mesh_program->set_uniform("s_BlueNoise", 6))
-            m_blue_noise_textures[m_temporal_accumulation ? m_frame_idx % NUM_BLUE_NOISE_TEXTURES : 0]->bind(6);
+            m_blue_noise_texture->bind(6);
 
         m_mesh_program->set_uniform("u_Tricubic", m_tricubic_filtering);
 
@@ -518,7 +635,9 @@ private:
             m_shadow_map->texture()->bind(0);
 
         if (m_light_injection_program->set_uniform("s_BlueNoise", 1))
-            m_blue_noise_textures[m_temporal_accumulation ? m_frame_idx % NUM_BLUE_NOISE_TEXTURES : 0]->bind(1);
+            m_blue_noise_texture->bind(1);
+
+        m_light_injection_program->set_uniform("u_BlueNoiseLayer", blue_noise_layer());
 
         if (m_light_injection_program->set_uniform("s_History", 2))
             m_temporal_integration_voxel_grid[read_idx]->bind(2);
@@ -568,6 +687,13 @@ private:
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
+    int32_t blue_noise_layer()
+    {
+        return m_temporal_accumulation ? m_frame_idx % m_blue_noise_layers : 0;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
     void update_camera()
     {
         dw::Camera* current = m_main_camera.get();
@@ -620,7 +746,7 @@ private:
     dw::gl::Texture3D::Ptr                   m_ray_march_voxel_grid;
     dw::gl::Texture3D::Ptr                   m_temporal_integration_voxel_grid[2];
     dw::gl::Buffer::Ptr                      m_ubo;
-    std::vector<dw::gl::Texture2D::Ptr>      m_blue_noise_textures;
+    dw::gl::Texture2D::Ptr                   m_blue_noise_texture;
 
     dw::Mesh::Ptr               m_mesh;
     glm::mat4                   m_transform;
@@ -631,6 +757,7 @@ private:
     float m_anisotropy            = 0.7f;
     float m_density               = 5.0f;
     int   m_frame_idx             = 0;
+    int   m_blue_noise_layers     = 1;
     bool  m_ping_pong             = false;
     bool  m_temporal_accumulation = true;
     bool  m_tricubic_filtering    = true;
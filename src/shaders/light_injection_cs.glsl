@@ -44,10 +44,11 @@ layout(std140, binding = 0) uniform Uniforms
 };
 
 uniform sampler2DShadow s_ShadowMap;
-uniform sampler2D s_BlueNoise;
+uniform sampler2DArray s_BlueNoise;
 uniform sampler3D s_History;
 
 uniform bool u_Accumulation;
+uniform int  u_BlueNoiseLayer;
 
 // ------------------------------------------------------------------
 // FUNCTIONS --------------------------------------------------------
@@ -102,8 +103,11 @@ float z_slice_thickness(int z)
 
 float sample_blue_noise(ivec3 coord)
 {
-    ivec2 noise_coord = (coord.xy + ivec2(0, 1) * coord.z * BLUE_NOISE_TEXTURE_SIZE) % BLUE_NOISE_TEXTURE_SIZE;
-    return texelFetch(s_BlueNoise, noise_coord, 0).r;
+    // Each layer of the array is 2D blue noise and each texel is blue over time, so the layer advances every frame.
+    // Depth slices are decorrelated by shifting the lookup along the R2 sequence.
+    ivec2 offset      = ivec2(fract(vec2(0.7548776662f, 0.5698402910f) * float(coord.z)) * float(BLUE_NOISE_TEXTURE_SIZE));
+    ivec2 noise_coord = (coord.xy + offset) % BLUE_NOISE_TEXTURE_SIZE;
+    return texelFetch(s_BlueNoise, ivec3(noise_coord, u_BlueNoiseLayer), 0).r;
 }
 
 // ------------------------------------------------------------------
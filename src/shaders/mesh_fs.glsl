@@ -50,7 +50,7 @@ uniform sampler2D       s_Metallic;
 uniform sampler2D       s_Roughness;
 uniform sampler2DShadow s_ShadowMap;
 uniform sampler3D       s_VoxelGrid;
-uniform sampler2D       s_BlueNoise;
+uniform sampler2DArray  s_BlueNoise;
 
 uniform bool u_Tricubic;
 
@@ -0,0 +1,466 @@
+#include "../blue_noise.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <limits>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Generates scalar spatiotemporal blue noise (Wolfe et al. 2022) with the void-and-cluster algorithm (Ulichney 1993).
+// Points only repel each other within the same layer (toroidal Gaussian in XY) or at the same pixel (toroidal Gaussian
+// along the time axis), so every layer is 2D blue noise on its own and every pixel is 1D blue noise across layers.
+
+#define DEFAULT_SIZE 128
+#define DEFAULT_DEPTH 16
+#define DEFAULT_SEED 1337
+#define SPATIAL_SIGMA 1.9f
+#define TEMPORAL_SIGMA 1.9f
+#define INITIAL_DENSITY 0.1f
+#define INVALID_INDEX 0xFFFFFFFF
+
+class VoidAndCluster
+{
+public:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    VoidAndCluster(uint32_t width, uint32_t height, uint32_t depth, uint32_t num_threads) :
+        m_width(width), m_height(height), m_depth(depth), m_num_threads(std::max(1u, std::min(num_threads, depth)))
+    {
+        m_size = m_width * m_height * m_depth;
+
+        m_energy.resize(m_size);
+        m_bits.resize(m_size);
+        m_row_void.resize(m_height * m_depth);
+        m_row_cluster.resize(m_height * m_depth);
+        m_results.resize(m_num_threads);
+
+        create_kernel();
+
+        // The calling thread acts as worker 0, the rest wait for jobs.
+        for (uint32_t i = 1; i < m_num_threads; i++)
+            m_workers.push_back(std::thread(&VoidAndCluster::worker_loop, this, i));
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    ~VoidAndCluster()
+    {
+        dispatch(JOB_QUIT, 0, 0.0f);
+
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Returns the rank of every texel in [0, width * height * depth).
+    std::vector<uint32_t> generate(uint32_t seed)
+    {
+        std::mt19937          rng(seed);
+        std::vector<uint32_t> ranks(m_size);
+
+        std::fill(m_energy.begin(), m_energy.end(), 0.0f);
+        std::fill(m_bits.begin(), m_bits.end(), 0);
+
+        dispatch(JOB_REBUILD, 0, 0.0f);
+
+        // Seed the initial binary pattern with random points.
+        uint32_t num_initial = std::max(1u, static_cast<uint32_t>(m_size * INITIAL_DENSITY));
+
+        std::vector<uint32_t> order(m_size);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (uint32_t i = 0; i < num_initial; i++)
+            set_bit(order[i], true);
+
+        // Relax the initial pattern by moving the tightest cluster into the largest void until it stops changing.
+        for (uint32_t i = 0; i < m_size; i++)
+        {
+            uint32_t cluster = find_tightest_cluster();
+
+            set_bit(cluster, false);
+
+            uint32_t largest_void = find_largest_void();
+
+            set_bit(largest_void, true);
+
+            if (largest_void == cluster)
+                break;
+        }
+
+        std::vector<float>   initial_energy = m_energy;
+        std::vector<uint8_t> initial_bits   = m_bits;
+
+        // Phase 1: rank the initial points by repeatedly removing the tightest cluster.
+        for (uint32_t ones = num_initial; ones > 0;)
+        {
+            uint32_t cluster = find_tightest_cluster();
+
+            set_bit(cluster, false);
+
+            ranks[cluster] = --ones;
+        }
+
+        m_energy = initial_energy;
+        m_bits   = initial_bits;
+
+        dispatch(JOB_REBUILD, 0, 0.0f);
+
+        // Phase 2 and 3: rank the remaining points by repeatedly filling the largest void.
+        uint32_t progress_step = m_size / 10;
+
+        for (uint32_t ones = num_initial; ones < m_size; ones++)
+        {
+            uint32_t largest_void = find_largest_void();
+
+            set_bit(largest_void, true);
+
+            ranks[largest_void] = ones;
+
+            if (ones % progress_step == 0)
+                printf("Progress: %u%%\n", (ones * 100 + m_size / 2) / m_size);
+        }
+
+        return ranks;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+private:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    enum JobType
+    {
+        JOB_SPLAT,
+        JOB_REBUILD,
+        JOB_QUIT
+    };
+
+    struct Extreme
+    {
+        float    value;
+        uint32_t index;
+    };
+
+    struct WorkerResult
+    {
+        Extreme largest_void;
+        Extreme tightest_cluster;
+    };
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void create_kernel()
+    {
+        m_radius = std::min(static_cast<int32_t>(ceil(3.0f * SPATIAL_SIGMA)), static_cast<int32_t>(std::min(m_width, m_height) - 1) / 2);
+
+        int32_t extent = 2 * m_radius + 1;
+
+        m_spatial_kernel.resize(extent * extent);
+
+        for (int32_t dy = -m_radius; dy <= m_radius; dy++)
+        {
+            for (int32_t dx = -m_radius; dx <= m_radius; dx++)
+                m_spatial_kernel[(dy + m_radius) * extent + (dx + m_radius)] = exp(-float(dx * dx + dy * dy) / (2.0f * SPATIAL_SIGMA * SPATIAL_SIGMA));
+        }
+
+        // Indexed by the wrapped distance along the time axis.
+        m_temporal_kernel.resize(m_depth);
+
+        for (uint32_t dz = 0; dz < m_depth; dz++)
+        {
+            float d = float(std::min(dz, m_depth - dz));
+
+            m_temporal_kernel[dz] = exp(-(d * d) / (2.0f * TEMPORAL_SIGMA * TEMPORAL_SIGMA));
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void set_bit(uint32_t index, bool value)
+    {
+        m_bits[index] = value ? 1 : 0;
+
+        dispatch(JOB_SPLAT, index, value ? 1.0f : -1.0f);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    uint32_t find_tightest_cluster()
+    {
+        Extreme best = m_results[0].tightest_cluster;
+
+        for (uint32_t i = 1; i < m_num_threads; i++)
+        {
+            if (m_results[i].tightest_cluster.value > best.value)
+                best = m_results[i].tightest_cluster;
+        }
+
+        return best.index;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    uint32_t find_largest_void()
+    {
+        Extreme best = m_results[0].largest_void;
+
+        for (uint32_t i = 1; i < m_num_threads; i++)
+        {
+            if (m_results[i].largest_void.value < best.value)
+                best = m_results[i].largest_void;
+        }
+
+        return best.index;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void dispatch(JobType type, uint32_t index, float sign)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_job_type  = type;
+            m_job_index = index;
+            m_job_sign  = sign;
+            m_pending   = m_num_threads - 1;
+            m_generation++;
+        }
+
+        m_start_cv.notify_all();
+
+        if (type == JOB_QUIT)
+            return;
+
+        execute(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done_cv.wait(lock, [this]() { return m_pending == 0; });
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void worker_loop(uint32_t worker)
+    {
+        uint64_t generation = 0;
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start_cv.wait(lock, [this, generation]() { return m_generation != generation; });
+
+            generation = m_generation;
+
+            if (m_job_type == JOB_QUIT)
+                return;
+
+            lock.unlock();
+
+            execute(worker);
+
+            lock.lock();
+
+            if (--m_pending == 0)
+                m_done_cv.notify_one();
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Each worker owns a contiguous range of layers and keeps the per-row extremes of that range up to date.
+    void execute(uint32_t worker)
+    {
+        uint32_t z_start = (worker * m_depth) / m_num_threads;
+        uint32_t z_end   = ((worker + 1) * m_depth) / m_num_threads;
+
+        if (m_job_type == JOB_SPLAT)
+        {
+            int32_t  extent = 2 * m_radius + 1;
+            uint32_t px     = m_job_index % m_width;
+            uint32_t py     = (m_job_index / m_width) % m_height;
+            uint32_t pz     = m_job_index / (m_width * m_height);
+
+            for (uint32_t z = z_start; z < z_end; z++)
+            {
+                if (z == pz)
+                {
+                    // Spatial energy within the layer of the point.
+                    for (int32_t dy = -m_radius; dy <= m_radius; dy++)
+                    {
+                        uint32_t y   = (py + dy + m_height) % m_height;
+                        float*   row = &m_energy[(z * m_height + y) * m_width];
+
+                        const float* kernel_row = &m_spatial_kernel[(dy + m_radius) * extent + m_radius];
+
+                        for (int32_t dx = -m_radius; dx <= m_radius; dx++)
+                            row[(px + dx + m_width) % m_width] += m_job_sign * kernel_row[dx];
+
+                        refresh_row(z, y);
+                    }
+                }
+                else
+                {
+                    // Temporal energy at the same pixel in every other layer.
+                    m_energy[(z * m_height + py) * m_width + px] += m_job_sign * m_temporal_kernel[(z + m_depth - pz) % m_depth];
+
+                    refresh_row(z, py);
+                }
+            }
+        }
+        else
+        {
+            for (uint32_t z = z_start; z < z_end; z++)
+            {
+                for (uint32_t y = 0; y < m_height; y++)
+                    refresh_row(z, y);
+            }
+        }
+
+        WorkerResult result = { { std::numeric_limits<float>::infinity(), INVALID_INDEX }, { -std::numeric_limits<float>::infinity(), INVALID_INDEX } };
+
+        for (uint32_t row = z_start * m_height; row < z_end * m_height; row++)
+        {
+            if (m_row_void[row].value < result.largest_void.value)
+                result.largest_void = m_row_void[row];
+
+            if (m_row_cluster[row].value > result.tightest_cluster.value)
+                result.tightest_cluster = m_row_cluster[row];
+        }
+
+        m_results[worker] = result;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void refresh_row(uint32_t z, uint32_t y)
+    {
+        uint32_t row   = z * m_height + y;
+        uint32_t start = row * m_width;
+
+        Extreme largest_void     = { std::numeric_limits<float>::infinity(), INVALID_INDEX };
+        Extreme tightest_cluster = { -std::numeric_limits<float>::infinity(), INVALID_INDEX };
+
+        for (uint32_t i = start; i < start + m_width; i++)
+        {
+            float energy = m_energy[i];
+
+            if (m_bits[i])
+            {
+                if (energy > tightest_cluster.value)
+                    tightest_cluster = { energy, i };
+            }
+            else if (energy < largest_void.value)
+                largest_void = { energy, i };
+        }
+
+        m_row_void[row]    = largest_void;
+        m_row_cluster[row] = tightest_cluster;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_depth;
+    uint32_t m_size;
+    uint32_t m_num_threads;
+    int32_t  m_radius;
+
+    std::vector<float>        m_spatial_kernel;
+    std::vector<float>        m_temporal_kernel;
+    std::vector<float>        m_energy;
+    std::vector<uint8_t>      m_bits;
+    std::vector<Extreme>      m_row_void;
+    std::vector<Extreme>      m_row_cluster;
+    std::vector<WorkerResult> m_results;
+
+    // Job dispatch.
+    std::vector<std::thread> m_workers;
+    std::mutex               m_mutex;
+    std::condition_variable  m_start_cv;
+    std::condition_variable  m_done_cv;
+    uint64_t                 m_generation = 0;
+    uint32_t                 m_pending    = 0;
+    JobType                  m_job_type   = JOB_REBUILD;
+    uint32_t                 m_job_index  = 0;
+    float                    m_job_sign   = 0.0f;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: BlueNoiseGenerator <output> [size] [depth] [seed]\n");
+        return 1;
+    }
+
+    std::string path  = argv[1];
+    uint32_t    size  = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : DEFAULT_SIZE;
+    uint32_t    depth = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : DEFAULT_DEPTH;
+    uint32_t    seed  = argc > 4 ? static_cast<uint32_t>(atoi(argv[4])) : DEFAULT_SEED;
+
+    if (size < 4 || depth < 1)
+    {
+        printf("Invalid blue noise dimensions: %ux%ux%u\n", size, size, depth);
+        return 1;
+    }
+
+    printf("Generating %ux%ux%u spatiotemporal blue noise...\n", size, size, depth);
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    VoidAndCluster        generator(size, size, depth, std::thread::hardware_concurrency());
+    std::vector<uint32_t> ranks = generator.generate(seed);
+
+    // Quantize ranks to 8-bit so that every value occurs equally often.
+    uint64_t             num_texels = ranks.size();
+    std::vector<uint8_t> texels(num_texels);
+
+    for (uint64_t i = 0; i < num_texels; i++)
+        texels[i] = static_cast<uint8_t>((ranks[i] * 256ull) / num_texels);
+
+    BlueNoiseFileHeader header;
+
+    header.magic       = BLUE_NOISE_FILE_MAGIC;
+    header.version     = BLUE_NOISE_FILE_VERSION;
+    header.width       = size;
+    header.height      = size;
+    header.depth       = depth;
+    header.data_offset = sizeof(BlueNoiseFileHeader);
+
+    FILE* f = fopen(path.c_str(), "wb");
+
+    if (!f)
+    {
+        printf("Failed to open file: %s\n", path.c_str());
+        return 1;
+    }
+
+    bool success = fwrite(&header, sizeof(BlueNoiseFileHeader), 1, f) == 1 && fwrite(texels.data(), 1, texels.size(), f) == texels.size();
+
+    fclose(f);
+
+    if (!success)
+    {
+        printf("Failed to write file: %s\n", path.c_str());
+        return 1;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    printf("Wrote %s in %.2f seconds\n", path.c_str(), std::chrono::duration<double>(end - start).count());
+
+    return 0;
+}